@@ -0,0 +1,227 @@
+#include "Arduino.h"
+
+#include "Arrangement.h"
+
+/**
+ * Arrangement::Arrangement - Initialize an empty arrangement
+ * @patterns    - the song's patterns, which entries refer to by index
+ * @numPatterns - how many patterns there are
+ */
+Arrangement::Arrangement( Pattern** patterns, int numPatterns) {
+    this->patterns = patterns;
+    this->numPatterns = numPatterns;
+    entries = (ArrangementEntry*)0;
+    numEntries = 0;
+    capacity = 0;
+    length = 0;
+}
+
+/**
+ * Arrangement::~Arrangement - Frees the entry list. The patterns belong to
+ * the song and are left alone.
+ */
+Arrangement::~Arrangement() {
+    free( entries);
+}
+
+/**
+ * Arrangement::insert - Insert an entry before index i. Returns false if the
+ *                       entry is invalid or there is no memory for it.
+ * @i         - where to insert. size() appends.
+ * @pattern   - index of the pattern in the song
+ * @repeats   - how many times to play the pattern, at least 1
+ * @transpose - semitones to add to every note
+ */
+bool Arrangement::insert( int i, byte pattern, byte repeats,
+                          signed char transpose) {
+    if (i < 0 || i > numEntries || pattern >= numPatterns || repeats == 0)
+        return false;
+
+    if (numEntries == capacity) {
+        int grow = capacity ? capacity * 2 : 4;
+        ArrangementEntry* e = (ArrangementEntry*)realloc(entries,
+            sizeof(ArrangementEntry) * grow);
+        if (e == 0)
+            return false;
+        entries = e;
+        capacity = grow;
+    }
+
+    memmove(&entries[i + 1], &entries[i],
+            sizeof(ArrangementEntry) * (numEntries - i));
+    entries[i].pattern   = pattern;
+    entries[i].repeats   = repeats;
+    entries[i].transpose = transpose;
+    numEntries++;
+
+    updateFrom(i);
+    return true;
+}
+
+/**
+ * Arrangement::append - Add an entry to the end of the arrangement
+ * @pattern   - index of the pattern in the song
+ * @repeats   - how many times to play the pattern, at least 1
+ * @transpose - semitones to add to every note
+ */
+bool Arrangement::append( byte pattern, byte repeats, signed char transpose) {
+    return insert(numEntries, pattern, repeats, transpose);
+}
+
+/**
+ * Arrangement::remove - Remove the entry at index i
+ * @i - the entry index
+ */
+void Arrangement::remove( int i) {
+    if (i < 0 || i >= numEntries)
+        return;
+
+    numEntries--;
+    memmove(&entries[i], &entries[i + 1],
+            sizeof(ArrangementEntry) * (numEntries - i));
+    updateFrom(i);
+}
+
+/**
+ * Arrangement::setPattern - Change which pattern entry i plays. Returns false
+ *                           if i or the pattern index is out of range.
+ * @i       - the entry index
+ * @pattern - index of the pattern in the song
+ */
+bool Arrangement::setPattern( int i, byte pattern) {
+    if (i < 0 || i >= numEntries || pattern >= numPatterns)
+        return false;
+    entries[i].pattern = pattern;
+    updateFrom(i + 1);
+    return true;
+}
+
+/**
+ * Arrangement::setRepeats - Change how many times entry i plays. Returns
+ *                           false if i is out of range or repeats is 0.
+ * @i       - the entry index
+ * @repeats - how many times to play the pattern, at least 1
+ */
+bool Arrangement::setRepeats( int i, byte repeats) {
+    if (i < 0 || i >= numEntries || repeats == 0)
+        return false;
+    entries[i].repeats = repeats;
+    updateFrom(i + 1);
+    return true;
+}
+
+/**
+ * Arrangement::setTranspose - Change the transposition of entry i
+ * @i         - the entry index
+ * @transpose - semitones to add to every note
+ */
+void Arrangement::setTranspose( int i, signed char transpose) {
+    if (i < 0 || i >= numEntries)
+        return;
+    entries[i].transpose = transpose;
+}
+
+/**
+ * Arrangement::clear - Remove every entry
+ */
+void Arrangement::clear() {
+    numEntries = 0;
+    length = 0;
+}
+
+/**
+ * Arrangement::update - Recompute start times. Call this after changing the
+ *                       length of a pattern used in the arrangement.
+ */
+void Arrangement::update() {
+    updateFrom(0);
+}
+
+/**
+ * Arrangement::updateFrom - Recompute start times from entry i onwards
+ * @i - the first entry whose start may have changed
+ */
+void Arrangement::updateFrom( int i) {
+    song_tick_t t = 0;
+    if (i > 0) {
+        ArrangementEntry* prev = &entries[i - 1];
+        t = prev->start + (song_tick_t)patterns[prev->pattern]->getLength() *
+                          prev->repeats;
+    }
+
+    for (; i < numEntries; i++) {
+        entries[i].start = t;
+        t += (song_tick_t)patterns[entries[i].pattern]->getLength() *
+             entries[i].repeats;
+    }
+    length = t;
+}
+
+/**
+ * Arrangement::size - gets the number of entries
+ */
+int Arrangement::size() {
+    return numEntries;
+}
+
+/**
+ * Arrangement::getEntry - gets an entry, or 0 if i is out of range. Use the
+ *                         setters to change it so start times stay correct.
+ * @i - the entry index
+ */
+const ArrangementEntry* Arrangement::getEntry( int i) {
+    if (i < 0 || i >= numEntries)
+        return (const ArrangementEntry*)0;
+    return &entries[i];
+}
+
+/**
+ * Arrangement::getLength - gets the length of the whole song in ticks
+ */
+song_tick_t Arrangement::getLength() {
+    return length;
+}
+
+/**
+ * Arrangement::seek - Find what is playing at a song position with a binary
+ *                     search over the entry start times. Returns the entry
+ *                     index, or -1 if t is past the end of the song or lands
+ *                     in a pattern whose length was set to 0 without calling
+ *                     update.
+ * @t   - the song position in ticks
+ * @pos - where to store the pattern, repeat and position inside it
+ */
+int Arrangement::seek( song_tick_t t, SongPosition* pos) {
+    pos->entry     = -1;
+    pos->pattern   = (Pattern*)0;
+    pos->repeat    = 0;
+    pos->ticks     = 0;
+    pos->transpose = 0;
+
+    if (t >= length)
+        return -1;
+
+    // Find the last entry starting at or before t. Entries with empty
+    // patterns share a start with the next one and are skipped over.
+    int lo = 0, hi = numEntries - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (entries[mid].start <= t)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+
+    ArrangementEntry* e = &entries[lo];
+    Pattern* p = patterns[e->pattern];
+    song_tick_t offset = t - e->start;
+    if (p->getLength() == 0)
+        return -1;
+
+    pos->entry     = lo;
+    pos->pattern   = p;
+    pos->repeat    = offset / p->getLength();
+    pos->ticks     = offset % p->getLength();
+    pos->transpose = e->transpose;
+    return lo;
+}
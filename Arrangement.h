@@ -0,0 +1,57 @@
+#ifndef Arrangement_h
+#define Arrangement_h
+#include "Pattern.h"
+#include "Ticks.h"
+
+#include "Arduino.h"
+
+typedef struct ArrangementEntry {
+    song_tick_t start;      // Where this entry begins in the song
+    byte        pattern;    // Index of the pattern in the song
+    byte        repeats;    // How many times the pattern plays
+    signed char transpose;  // Semitones to add to every note
+} ArrangementEntry;
+
+typedef struct SongPosition {
+    int         entry;      // Index of the entry, or -1 past the end
+    Pattern*    pattern;
+    byte        repeat;     // Which repeat of the pattern is playing
+    tick_t      ticks;      // Position inside the pattern
+    signed char transpose;
+} SongPosition;
+
+// Arrangement lays patterns out on a song timeline, for example
+// "A A B A C", without copying them. Each entry names a pattern by its index
+// in the song along with a repeat count and a transposition. Start times are
+// kept up to date as entries change, so seeking to any song position is a
+// binary search. Call update after changing a pattern's length.
+class Arrangement {
+  private:
+    Pattern**         patterns;
+    int               numPatterns;
+    ArrangementEntry* entries;
+    int               numEntries;
+    int               capacity;
+    song_tick_t       length;
+
+    void updateFrom(int);
+  public:
+    Arrangement( Pattern**, int);
+    ~Arrangement();
+
+    bool insert( int, byte, byte, signed char);
+    bool append( byte, byte, signed char);
+    void remove(int);
+    bool setPattern( int, byte);
+    bool setRepeats( int, byte);
+    void setTranspose( int, signed char);
+    void clear();
+    void update();
+
+    int               size();
+    const ArrangementEntry* getEntry(int);
+    song_tick_t       getLength();
+    int               seek( song_tick_t, SongPosition*);
+};
+
+#endif
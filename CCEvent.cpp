@@ -9,7 +9,7 @@
  * @value  - CC value
  * @interploate - If we should interpolate to the next CC
  */
-CCEvent::CCEvent( int ticks, int number, int value, bool interpolate) {
+CCEvent::CCEvent( tick_t ticks, int number, int value, bool interpolate) {
     this->ticks = ticks;
     CC *cc = (CC*)malloc(sizeof(CC));
 
@@ -19,6 +19,7 @@ CCEvent::CCEvent( int ticks, int number, int value, bool interpolate) {
     cc->list = (CC*)0;
 
     this->ccs = cc;
+    prev = (CCEvent*)0;
     next = (CCEvent*)0;
 }
 
@@ -42,7 +43,7 @@ CCEvent::~CCEvent() {
  * @value       - the value of the control change
  * @interpolate - whether or not to interpolate to the next CC CCEvent
  */
-CCEvent* CCEvent::add( int t, int number, int value, bool interpolate) {
+CCEvent* CCEvent::add( tick_t t, int number, int value, bool interpolate) {
     // If we're inserting before the first CC in our list
     if (t < ticks) {
         CCEvent *cc = new CCEvent(t, number, value, interpolate);
@@ -77,7 +78,7 @@ CCEvent* CCEvent::add( int t, int number, int value, bool interpolate) {
         ccs      = cc;
     }
     // Place CCEvent between this and the next if it belongs
-    else if (t > ticks && t < next->getTime()) {
+    else if (t > ticks && next != NULL && t < next->getTime()) {
         
         CCEvent *e = new CCEvent(t, number, value, interpolate);
 
@@ -120,7 +121,7 @@ CC* CCEvent::getCCs() {
  * CCEvent::remove - remove a CC from the list of CC's in this CCEvent
  * @n - the CC number to be removed
  */
-CCEvent* CCEvent::remove( int t, int number) {
+CCEvent* CCEvent::remove( tick_t t, int number) {
     // Is it this time?
     if (t == ticks) {
         // iterate through cc list to see if we have a match
@@ -136,6 +137,7 @@ CCEvent* CCEvent::remove( int t, int number) {
                     delete this;
                     return returnCC;
                 }
+                return this;
             }
             // This should happen for the rest of the notes
             else if (cc->list != 0 && cc->list->number == number) {
@@ -145,7 +147,7 @@ CCEvent* CCEvent::remove( int t, int number) {
                 return this;
             }
         }
-    } else if (t > ticks) {
+    } else if (t > ticks && next != NULL) {
         next = next->remove(t, number);
     }
     return this;
@@ -154,6 +156,6 @@ CCEvent* CCEvent::remove( int t, int number) {
 /**
  * CCEvent::getTime - gets the time of this CCEvent in ticks
  */
-int CCEvent::getTime() {
+tick_t CCEvent::getTime() {
     return ticks;
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #ifndef CCEvent_h
 #define CCEvent_h
+#include "Ticks.h"
+
 #include "Arduino.h"
 
 typedef struct CC {
@@ -15,18 +17,18 @@ typedef struct CC {
 // A MIDI parser may iterate through events to queue up data to send.
 class CCEvent {
   private:
-    int ticks;
+    tick_t ticks;
     CC* ccs;        // Also a stack implemented as a linked list
     CCEvent *prev, *next;
   public:
-    CCEvent( int, int, int, bool);
+    CCEvent( tick_t, int, int, bool);
     ~CCEvent();
-    CCEvent* add( int, int, int, bool);
-    CCEvent* remove(int, int);
+    CCEvent* add( tick_t, int, int, bool);
+    CCEvent* remove( tick_t, int);
     CCEvent* getNext();
     
     CC*   getCCs();
-    int   getTime();
+    tick_t getTime();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,287 @@
+#include "Arduino.h"
+
+#include "ChangeLog.h"
+
+/**
+ * ChangeLog::ChangeLog - Initialize a disabled log at version 0. The ring
+ * buffer is not allocated until enable is called, so patterns that are never
+ * synced cost nothing.
+ */
+ChangeLog::ChangeLog() {
+    changes = (Change*)0;
+    version = 0;
+    checksum = 0;
+    count = 0;
+    head = 0;
+}
+
+/**
+ * ChangeLog::~ChangeLog - Free the ring buffer
+ */
+ChangeLog::~ChangeLog() {
+    free( changes);
+}
+
+/**
+ * ChangeLog::enable - Allocate the ring buffer and start recording edits.
+ *                     Returns false if there is no memory for it.
+ */
+bool ChangeLog::enable() {
+    if (changes == 0)
+        changes = (Change*)malloc(sizeof(Change) * change_log_size);
+    return changes != 0;
+}
+
+/**
+ * ChangeLog::isEnabled - true once enable has succeeded
+ */
+bool ChangeLog::isEnabled() {
+    return changes != 0;
+}
+
+/**
+ * ChangeLog::hash - Hash one change together with the version it produced.
+ *                   Uses fixed 16-bit arithmetic so every board agrees.
+ * @v - the version the change produced
+ * @c - the change
+ */
+uint16_t ChangeLog::hash( unsigned int v, Change* c) {
+    uint16_t h = 0x811c;
+    uint16_t fields[7];
+    fields[0] = (uint16_t)v;
+    fields[1] = c->op;
+    fields[2] = (uint16_t)c->ticks;
+    fields[3] = (uint16_t)((unsigned long)c->ticks >> 16);
+    fields[4] = (uint16_t)c->number;
+    fields[5] = (uint16_t)c->value ^ (uint16_t)((unsigned long)c->value >> 16);
+    fields[6] = (uint16_t)c->extra;
+    for (byte i = 0; i < 7; i++)
+        h = (uint16_t)((h ^ fields[i]) * 0x0193);
+    return h;
+}
+
+/**
+ * ChangeLog::record - Remember an edit and bump the version
+ * @op     - the change operation (change_note_add etc.)
+ * @ticks  - the timing of the edited event
+ * @number - the note or CC number
+ * @value  - the note length or CC value
+ * @extra  - the note velocity or CC interpolate flag
+ */
+void ChangeLog::record( byte op, tick_t ticks, int number, tick_t value,
+                        int extra) {
+    if (changes == 0)
+        return;
+    version++;
+
+    Change* c = &changes[head];
+    c->op     = op;
+    c->ticks  = ticks;
+    c->number = number;
+    c->value  = value;
+    c->extra  = extra;
+    checksum += hash(version, c);
+
+    head = (head + 1) % change_log_size;
+    if (count < change_log_size)
+        count++;
+}
+
+/**
+ * ChangeLog::getVersion - gets the number of edits made so far
+ */
+unsigned int ChangeLog::getVersion() {
+    return version;
+}
+
+/**
+ * ChangeLog::getChecksum - gets the checksum of every edit made so far. Two
+ *                          patterns with the same version and checksum have
+ *                          the same history.
+ */
+uint16_t ChangeLog::getChecksum() {
+    return checksum;
+}
+
+/**
+ * ChangeLog::getChecksum - gets the checksum as it was at an earlier version
+ *                          still in the log, by taking the newer edits back
+ *                          out. Returns the current checksum if v is too old.
+ * @v - the version
+ */
+uint16_t ChangeLog::getChecksum( unsigned int v) {
+    uint16_t sum = checksum;
+    for (unsigned int u = version; u != v; u--) {
+        Change* c = getChange(u);
+        if (c == 0)
+            break;
+        sum -= hash(u, c);
+    }
+    return sum;
+}
+
+/**
+ * ChangeLog::getChange - gets the change that produced version v, or 0 if it
+ *                        has already been dropped from the log
+ * @v - the version
+ */
+Change* ChangeLog::getChange( unsigned int v) {
+    // Distance back from the newest change, unsigned so it survives wrapping
+    unsigned int age = version - v;
+    if (v == 0 || age >= count)
+        return (Change*)0;
+
+    int slot = (int)head - 1 - (int)age;
+    if (slot < 0)
+        slot += change_log_size;
+    return &changes[slot];
+}
+
+/**
+ * ChangeLog::encode - Write a delta that brings a peer at version since up
+ *                     to the current version. Returns the number of bytes
+ *                     written, or -1 if the log is disabled, no longer reaches
+ *                     back that far or buf is too small.
+ * @since - the version the peer already has
+ * @buf   - destination buffer
+ * @size  - size of buf in bytes
+ */
+int ChangeLog::encode( unsigned int since, byte* buf, int size) {
+    unsigned int n = version - since;
+    if (changes == 0 || n > count)
+        return -1;
+
+    int len = writeInt(since, buf, size);
+    if (len < 0 || len + 3 > size)
+        return -1;
+    uint16_t sum = getChecksum(since);
+    buf[len++] = sum & 0xff;
+    buf[len++] = sum >> 8;
+    buf[len++] = (byte)n;
+
+    tick_t prev = 0;
+    for (unsigned int v = since + 1; v != version + 1; v++) {
+        Change* c = getChange(v);
+        int w;
+
+        if (len >= size)
+            return -1;
+        buf[len++] = c->op;
+
+        if (c->op == change_clear)
+            continue;
+
+        // Zigzag the difference so small steps back stay small
+        tick_diff_t d = (tick_diff_t)(c->ticks - prev);
+        tick_t z = ((tick_t)d << 1) ^ (tick_t)(d < 0 ? -1 : 0);
+        prev = c->ticks;
+
+        w = writeInt(z, buf + len, size - len);
+        if (w < 0) return -1;
+        len += w;
+        w = writeInt((unsigned int)c->number, buf + len, size - len);
+        if (w < 0) return -1;
+        len += w;
+
+        if (c->op == change_note_add || c->op == change_cc_add) {
+            w = writeInt(c->value, buf + len, size - len);
+            if (w < 0) return -1;
+            len += w;
+            w = writeInt((unsigned int)c->extra, buf + len, size - len);
+            if (w < 0) return -1;
+            len += w;
+        }
+    }
+    return len;
+}
+
+/**
+ * ChangeLog::writeInt - Write a variable-length integer. Returns the number
+ *                       of bytes written, or -1 if buf is too small.
+ * @v    - the value
+ * @buf  - destination buffer
+ * @size - size of buf in bytes
+ */
+int ChangeLog::writeInt( unsigned long v, byte* buf, int size) {
+    int len = 0;
+    do {
+        if (len >= size)
+            return -1;
+        byte b = v & 0x7f;
+        v >>= 7;
+        buf[len++] = v ? (b | 0x80) : b;
+    } while (v);
+    return len;
+}
+
+/**
+ * ChangeLog::readInt - Read a variable-length integer. Returns the number of
+ *                      bytes read, or -1 if buf ends too soon.
+ * @buf  - source buffer
+ * @size - bytes available in buf
+ * @v    - where to store the value
+ */
+int ChangeLog::readInt( const byte* buf, int size, unsigned long* v) {
+    unsigned long result = 0;
+    byte shift = 0;
+    for (int len = 0; len < size; len++) {
+        result |= (unsigned long)(buf[len] & 0x7f) << shift;
+        if ((buf[len] & 0x80) == 0) {
+            *v = result;
+            return len + 1;
+        }
+        shift += 7;
+    }
+    return -1;
+}
+
+/**
+ * ChangeLog::readChange - Read one change record from a delta. Returns the
+ *                         number of bytes read, or -1 if the record is
+ *                         malformed or truncated.
+ * @buf  - source buffer
+ * @size - bytes available in buf
+ * @prev - ticks of the previous record, updated as records are read. Start
+ *         at 0 for the first record of a delta.
+ * @c    - where to store the change
+ */
+int ChangeLog::readChange( const byte* buf, int size, tick_t* prev,
+                           Change* c) {
+    unsigned long v;
+    int len = 0;
+    int r;
+
+    if (size < 1)
+        return -1;
+    c->op = buf[len++];
+    c->ticks = c->number = c->value = c->extra = 0;
+
+    if (c->op == change_clear)
+        return len;
+    if (c->op < change_note_add || c->op > change_cc_remove)
+        return -1;
+
+    r = readInt(buf + len, size - len, &v);
+    if (r < 0) return -1;
+    len += r;
+    // Undo the zigzag and apply the difference
+    tick_t z = (tick_t)v;
+    *prev += (z >> 1) ^ (tick_t)(0 - (z & 1));
+    c->ticks = *prev;
+    r = readInt(buf + len, size - len, &v);
+    if (r < 0) return -1;
+    len += r;
+    c->number = (int)v;
+
+    if (c->op == change_note_add || c->op == change_cc_add) {
+        r = readInt(buf + len, size - len, &v);
+        if (r < 0) return -1;
+        len += r;
+        c->value = (tick_t)v;
+        r = readInt(buf + len, size - len, &v);
+        if (r < 0) return -1;
+        len += r;
+        c->extra = (int)v;
+    }
+    return len;
+}
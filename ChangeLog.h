@@ -0,0 +1,78 @@
+#ifndef ChangeLog_h
+#define ChangeLog_h
+#include "Ticks.h"
+
+#include "Arduino.h"
+
+// Number of edits a pattern remembers for delta sync. Deltas carry the change
+// count in a single byte, so this can be at most 255. Keep it above
+// record_take_size if recorded takes are synced, since every merged note is
+// one change.
+#ifndef change_log_size
+#define change_log_size 32
+#endif
+#if change_log_size > 255
+#error "change_log_size must be at most 255"
+#endif
+
+// Worst case size of an encoded delta in bytes: a header plus a full log of
+// records with every field at its longest
+#define max_delta_size (8 + change_log_size * 21)
+
+// Change operations
+#define change_note_add    1
+#define change_note_remove 2
+#define change_cc_add      3
+#define change_cc_remove   4
+#define change_clear       5
+
+typedef struct Change {
+    byte   op;
+    tick_t ticks;
+    int    number;   // Note or CC number
+    tick_t value;    // Note length or CC value
+    int    extra;    // Note velocity or CC interpolate flag
+} Change;
+
+// ChangeLog remembers the most recent edits made to a pattern so linked
+// devices can be brought up to date by sending only what changed. It costs
+// nothing until enable is called. Every edit then bumps the version by one and
+// folds a hash of the edit into a checksum of the pattern's history. The log
+// is a ring buffer, so a peer that falls more than change_log_size edits
+// behind needs the whole pattern resent.
+//
+// Deltas are encoded as:
+//   base version as a variable-length integer, the two-byte history checksum
+//   at that version, a one-byte change count, then one record per change
+// where each record is an op byte followed by its fields as variable-length
+// integers (7 bits per byte, high bit set on all but the last byte). Ticks are
+// sent as the signed difference from the previous record so wide ticks still
+// take a byte or two.
+class ChangeLog {
+  private:
+    Change*      changes;  // Allocated by enable
+    unsigned int version;
+    uint16_t     checksum;
+    byte         count;
+    byte         head;     // Slot the next change is written to
+
+    static uint16_t hash( unsigned int, Change*);
+  public:
+    ChangeLog();
+    ~ChangeLog();
+
+    bool          enable();
+    bool          isEnabled();
+    void          record( byte, tick_t, int, tick_t, int);
+    unsigned int  getVersion();
+    uint16_t      getChecksum();
+    uint16_t      getChecksum(unsigned int);
+    Change*       getChange(unsigned int);
+    int           encode( unsigned int, byte*, int);
+
+    static int    writeInt( unsigned long, byte*, int);
+    static int    readInt( const byte*, int, unsigned long*);
+    static int    readChange( const byte*, int, tick_t*, Change*);
+};
+
+#endif
@@ -9,7 +9,7 @@
  * @length   - The length of the note
  * @velocity - velocity of the note
  */
-NoteEvent::NoteEvent( int t, int note, int length, int velocity) {
+NoteEvent::NoteEvent( tick_t t, int note, tick_t length, int velocity) {
     ticks = t;
     Note *n = (Note*)malloc(sizeof(Note));
 
@@ -19,6 +19,7 @@ NoteEvent::NoteEvent( int t, int note, int length, int velocity) {
     n->list = (Note*)0;
 
     this->notes = n;
+    prev = (NoteEvent*)0;
     next = (NoteEvent*)0;
 }
 
@@ -42,7 +43,7 @@ NoteEvent::~NoteEvent() {
  * @length   - the length of the note
  * @velocity - velocity of the note
  */
-NoteEvent* NoteEvent::add( int t, int note, int length, int velocity) {
+NoteEvent* NoteEvent::add( tick_t t, int note, tick_t length, int velocity) {
     // If we're inserting before the first note in our list
     if (t < ticks) {
         NoteEvent *n = new NoteEvent(t, note, length, velocity);
@@ -77,7 +78,7 @@ NoteEvent* NoteEvent::add( int t, int note, int length, int velocity) {
         notes   = n;
     }
     // Place NoteEvent between this and the next if it belongs
-    else if (t > ticks && t < next->getTime()) {
+    else if (t > ticks && next != NULL && t < next->getTime()) {
         
         NoteEvent *e = new NoteEvent(t, note, length, velocity);
 
@@ -108,7 +109,7 @@ NoteEvent* NoteEvent::add( int t, int note, int length, int velocity) {
  * @t - the time of the note to be removed
  * @note - the note number to be removed
  */
-NoteEvent* NoteEvent::remove(int t, int note) {
+NoteEvent* NoteEvent::remove( tick_t t, int note) {
     // Is it this time?
     if (t == ticks) {
         // iterate through note list to see if we have a match
@@ -124,6 +125,7 @@ NoteEvent* NoteEvent::remove(int t, int note) {
                     delete this;
                     return returnNote;
                 }
+                return this;
             }
             // This should happen for the rest of the notes
             else if (n->list != 0 && n->list->note == note) {
@@ -133,7 +135,7 @@ NoteEvent* NoteEvent::remove(int t, int note) {
                 return this;
             }
         }
-    } else if (t > ticks) {
+    } else if (t > ticks && next != NULL) {
         next = next->remove(t, note);
     }
     return this;
@@ -156,6 +158,6 @@ Note* NoteEvent::getNotes() {
 /**
  * NoteEvent::getTime - gets the time of this NoteEvent in ticks
  */
-int NoteEvent::getTime() {
+tick_t NoteEvent::getTime() {
     return ticks;
 }
\ No newline at end of file
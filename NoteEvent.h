@@ -1,10 +1,12 @@
 #ifndef NoteEvent_h
 #define NoteEvent_h
+#include "Ticks.h"
+
 #include "Arduino.h"
 
 typedef struct Note {
     int note;
-    int length;
+    tick_t length;
     int velocity;
     Note* list;
 } Note;
@@ -15,18 +17,18 @@ typedef struct Note {
 // A MIDI parser may iterate through events to queue up data to send.
 class NoteEvent {
   private:
-    int ticks;
+    tick_t ticks;
     Note* notes;    // A stack implemented as a linked list
     NoteEvent *prev, *next;
   public:
-    NoteEvent( int, int, int, int);
+    NoteEvent( tick_t, int, tick_t, int);
     ~NoteEvent();
-    NoteEvent* add( int, int, int, int);
-    NoteEvent* remove( int, int);
+    NoteEvent* add( tick_t, int, tick_t, int);
+    NoteEvent* remove( tick_t, int);
     NoteEvent* getNext();
     
     Note* getNotes();
-    int   getTime();
+    tick_t getTime();
 };
 
 #endif
\ No newline at end of file
@@ -14,19 +14,26 @@ Pattern::Pattern() {
     ccs = (CCEvent*)0;
     currentCC = ccs;
     follow = this;
+    length = 0;
+    rom = (const PatternLiteral*)0;
+    romNote = 0;
+    romCC = 0;
 }
 
 /**
  * Pattern::~Pattern - Destroy this pattern. Deletes the lists it contains
  */
 Pattern::~Pattern() {
-    clear();
+    freeEvents();
 }
 
 /**
- * Pattern::nextNote() - gets the next 
+ * Pattern::nextNote() - gets the next NoteEvent. A pattern playing from a
+ *                       literal is first copied into RAM; use readNote to
+ *                       play it straight from flash instead.
  */
 NoteEvent* Pattern::nextNote() {
+    promote();
     if (currentNote == (NoteEvent*)0) {
         return currentNote;
     }
@@ -38,49 +45,55 @@ NoteEvent* Pattern::nextNote() {
 /**
  * Pattern::gotoNote - grabs the next note after t ticks. Works by iterating
  *                     through the list of notes. Sets currentNote to that note.
+ *                     Like nextNote, this copies a literal into RAM; use
+ *                     gotoLiteral to move the readNote position instead.
  * @t - tick count
  */
-NoteEvent* Pattern::gotoNote(int t) {
+NoteEvent* Pattern::gotoNote( song_tick_t t) {
     NoteEvent* n = getNote(t);
     currentNote = n;
     return n;
 }
 
 /**
- * Pattern::getNote - grabs the next note after t ticks. Works by iterating
- *                    through the list of notes
+ * Pattern::getNote - grabs the first note at or after t ticks. Works by
+ *                    iterating through the list of notes. Copies a literal
+ *                    into RAM first.
  * @t - tick count
  */
-NoteEvent* Pattern::getNote(int t) {
-    for (NoteEvent* n = notes; n->getNext() != NULL; n = n->getNext()) {
-        if (n->getTime() < t && n->getNext()->getTime() >= t) {
-            return n->getNext();
+NoteEvent* Pattern::getNote( song_tick_t t) {
+    promote();
+    if (!tick_in_range(t))
+        return (NoteEvent*)0;
+    for (NoteEvent* n = notes; n != NULL; n = n->getNext()) {
+        if (n->getTime() >= t) {
+            return n;
         }
     }
+    return (NoteEvent*)0;
 }
 
 /**
  * Pattern::getNote - grabs the next note n after t ticks. Works by iterating
- *                    through the list of notes
+ *                    through the list of notes. Copies a literal into RAM
+ *                    first, so the returned note can be edited in place.
  * @t - tick count
  * @n - the note number
  */
-Note* Pattern::getNote(int t, int n) {
-    for (NoteEvent* ne = notes; ne->getNext() != NULL; ne = ne->getNext()) {
-        if (ne->getTime() < t && ne->getNext()->getTime() >= t) {
-            // Found our t. Let's get our n
-            ne = ne->getNext();
-            for (Note* note = ne->getNotes(); note != NULL; note = note->list)
-                if (n == note->note)
-                    return note;
-                else
-                    return (Note*)0;
-        }
-    }
+Note* Pattern::getNote( song_tick_t t, int n) {
+    NoteEvent* ne = getNote(t);
+    if (ne == NULL)
+        return (Note*)0;
+    // Found our t. Let's get our n
+    for (Note* note = ne->getNotes(); note != NULL; note = note->list)
+        if (n == note->note)
+            return note;
+    return (Note*)0;
 }
 
 /**
- * Pattern::addNote - Add a new note to a pattern.
+ * Pattern::addNote - Add a new note to a pattern. Returns false if ticks or
+ *                    length is past max_tick.
  *                    Beware - after calling this, nextNote will return the
  *                    first note in the list. It is recommended that you call 
  *                    'gotoNote' immediately after calling this.
@@ -89,7 +102,11 @@ Note* Pattern::getNote(int t, int n) {
  * @length   - the length of the note
  * @velocity - the velocity of the note
  */
-void Pattern::addNote( int ticks, int note, int length, int velocity) {
+bool Pattern::addNote( song_tick_t ticks, int note, song_tick_t length,
+                       int velocity) {
+    if (!tick_in_range(ticks) || !tick_in_range(length))
+        return false;
+    promote();
     if (notes == 0) {
         notes = new NoteEvent(ticks, note, length, velocity);
         currentNote = notes;
@@ -99,6 +116,8 @@ void Pattern::addNote( int ticks, int note, int length, int velocity) {
         notes = notes->add(ticks, note, length, velocity);
     }
     currentNote = notes;
+    log.record(change_note_add, ticks, note, length, velocity);
+    return true;
 }
 
 /**
@@ -108,38 +127,88 @@ void Pattern::addNote( int ticks, int note, int length, int velocity) {
  * @ticks - the time that the note occurs
  * @note  - the note number
  */
-void Pattern::removeNote( int ticks, int note) {
-    if (notes == 0)
+void Pattern::removeNote( song_tick_t ticks, int note) {
+    if (!tick_in_range(ticks))
         return;
-    else
+    promote();
+    if (notes != 0)
         notes = notes->remove(ticks, note);
 
     currentNote = notes;
+    log.record(change_note_remove, ticks, note, 0, 0);
 }
 
 /**
  * Pattern::moveNote - Moves the specified note from t0 to tF. gotoNote should
- *                     be called immediately after this
+ *                     be called immediately after this. Returns false if
+ *                     there is no such note or tF is past max_tick.
  * @t0 - initial t value of note
  * @tF - final t value of note
  * @n  - the note
  */
-void Pattern::moveNote( int t0, int tF, int n) {
+bool Pattern::moveNote( song_tick_t t0, song_tick_t tF, int n) {
+    if (!tick_in_range(tF))
+        return false;
+    promote();
     // Get the note structure we'll be moving
+    NoteEvent* ne = getNote(t0);
+    if (ne == NULL || ne->getTime() != t0)
+        return false;
     Note* note = getNote(t0, n);
-    int l = note->length;
-    int v = note->velocity;
+    if (note == NULL)
+        return false;
+    tick_t l = note->length;
+    int    v = note->velocity;
     // Remove it from the list
     removeNote(t0, n);
     // Re-insert it
-    addNote(tF, n, l, v);
+    return addNote(tF, n, l, v);
 }
 
+/**
+ * Pattern::mergeNotes - Add a batch of notes in a single walk of the list.
+ *                       Used by Recorder to overdub a take. Resets the note
+ *                       iterator like addNote.
+ * @batch - the notes, in RAM, sorted by ticks
+ * @count - the number of notes in batch
+ */
+void Pattern::mergeNotes( const NoteLiteral* batch, int count) {
+    // Nothing played this loop. Leave a literal in flash.
+    if (count == 0)
+        return;
+    promote();
+
+    NoteEvent* at = notes;
+    for (int i = 0; i < count; i++) {
+        const NoteLiteral* n = &batch[i];
+
+        if (notes == 0) {
+            notes = new NoteEvent(n->ticks, n->note, n->length, n->velocity);
+            at = notes;
+        }
+        else if (n->ticks < notes->getTime()) {
+            notes = notes->add(n->ticks, n->note, n->length, n->velocity);
+            at = notes;
+        }
+        else {
+            // The batch is sorted, so carry on from where the last note went
+            while (at->getNext() != NULL &&
+                   n->ticks >= at->getNext()->getTime())
+                at = at->getNext();
+            at->add(n->ticks, n->note, n->length, n->velocity);
+        }
+        log.record(change_note_add, n->ticks, n->note, n->length, n->velocity);
+    }
+    currentNote = notes;
+}
 
 /**
- * Pattern::nextCC - gets the next CC. Updates iterator
+ * Pattern::nextCC - gets the next CC. Updates iterator. A pattern playing
+ *                   from a literal is first copied into RAM; use readCC to
+ *                   play it straight from flash instead.
  */
 CCEvent* Pattern::nextCC() {
+    promote();
     if (currentCC == (CCEvent*)0) {
         return currentCC;
     }
@@ -150,51 +219,56 @@ CCEvent* Pattern::nextCC() {
 
 /**
  * Pattern::gotoCC - grabs the next CC after t ticks. Works by iterating
- *                   through the list of CC's
+ *                   through the list of CC's. Like nextCC, this copies a
+ *                   literal into RAM; use gotoLiteral to move the readCC
+ *                   position instead.
  * @t - tick count
  */
-CCEvent* Pattern::gotoCC(int t) {
+CCEvent* Pattern::gotoCC( song_tick_t t) {
     CCEvent* cc = getCC(t);
     currentCC = cc;
     return cc;
 }
 
 /**
- * Pattern::getCC - grabs the next CC after t ticks. Works by iterating
- *                  through the list of CCs
+ * Pattern::getCC - grabs the first CC at or after t ticks. Works by
+ *                  iterating through the list of CCs. Copies a literal
+ *                  into RAM first.
  * @t - tick count
  */
-CCEvent* Pattern::getCC(int t) {
-    for (CCEvent* cc = ccs; cc->getNext() != NULL; cc = cc->getNext()) {
-        if (cc->getTime() < t && cc->getNext()->getTime() >= t) {
-            currentCC = cc->getNext();
-            return cc->getNext();
+CCEvent* Pattern::getCC( song_tick_t t) {
+    promote();
+    if (!tick_in_range(t))
+        return (CCEvent*)0;
+    for (CCEvent* cc = ccs; cc != NULL; cc = cc->getNext()) {
+        if (cc->getTime() >= t) {
+            return cc;
         }
     }
+    return (CCEvent*)0;
 }
 
 /**
- * Pattern::getCC - grabs the next CC after t ticks. Works by iterating
- *                  through the list of CCs
+ * Pattern::getCC - grabs the first CC c at or after t ticks. Works by
+ *                  iterating through the list of CCs. Copies a literal into
+ *                  RAM first, so the returned CC can be edited in place.
  * @t - tick count
  * @c - the CC number
  */
-CC* Pattern::getCC(int t, int c) {
-    for (CCEvent* ce = ccs; ce->getNext() != NULL; ce = ce->getNext()) {
-        if (ce->getTime() < t && ce->getNext()->getTime() >= t) {
-            // Found our t. Let's get our c
-            ce = ce->getNext();
-            for (CC* cc = ce->getCCs(); cc != NULL; cc = cc->list)
-                if (c == cc->number)
-                    return cc;
-                else
-                    return (CC*)0;
-        }
-    }
+CC* Pattern::getCC( song_tick_t t, int c) {
+    CCEvent* ce = getCC(t);
+    if (ce == NULL)
+        return (CC*)0;
+    // Found our t. Let's get our c
+    for (CC* cc = ce->getCCs(); cc != NULL; cc = cc->list)
+        if (c == cc->number)
+            return cc;
+    return (CC*)0;
 }
 
 /**
- * Pattern::addEvent - Add a new CC to a pattern.
+ * Pattern::addEvent - Add a new CC to a pattern. Returns false if ticks is
+ *                     past max_tick.
  *                     Beware - after calling this, nextCC will return the
  *                     first note in the list. It is recommended that you call
  *                     'gotoCC' immediately after calling this.
@@ -203,16 +277,22 @@ CC* Pattern::getCC(int t, int c) {
  * @value       - the CC value to add
  * @interpolate - whether this CC interpolates or not
  */
-void Pattern::addCC( int ticks, int number, int value, bool interpolate) {
+bool Pattern::addCC( song_tick_t ticks, int number, int value,
+                     bool interpolate) {
+    if (!tick_in_range(ticks))
+        return false;
+    promote();
     if (ccs == 0) {
         ccs = new CCEvent(ticks, number, value, interpolate);
         currentCC = ccs;
     }
     else {
         CCEvent* currentStart = ccs;
-        ccs->add(ticks, number, value, interpolate);
+        ccs = ccs->add(ticks, number, value, interpolate);
     }
     currentCC = ccs;
+    log.record(change_cc_add, ticks, number, value, interpolate);
+    return true;
 }
 
 /**
@@ -222,31 +302,42 @@ void Pattern::addCC( int ticks, int number, int value, bool interpolate) {
  * @ticks - the time of the CC to remove
  * @cc    - the CC number to remove
  */
-void Pattern::removeCC( int ticks, int cc) {
-    if (ccs == 0)
+void Pattern::removeCC( song_tick_t ticks, int cc) {
+    if (!tick_in_range(ticks))
         return;
-    else
+    promote();
+    if (ccs != 0)
         ccs = ccs->remove(ticks, cc);
 
     currentCC = ccs;
+    log.record(change_cc_remove, ticks, cc, 0, 0);
 }
 
 /**
  * Pattern::moveCC - Moves the specified CC from t0 to tF. gotoCC should
- *                   be called immediately after this
+ *                   be called immediately after this. Returns false if
+ *                   there is no such CC or tF is past max_tick.
  * @t0 - initial t value of note
  * @tF - final t value of note
  * @c  - the CC
  */
-void Pattern::moveCC( int t0, int tF, int c) {
+bool Pattern::moveCC( song_tick_t t0, song_tick_t tF, int c) {
+    if (!tick_in_range(tF))
+        return false;
+    promote();
     // Get the note structure we'll be moving
+    CCEvent* ce = getCC(t0);
+    if (ce == NULL || ce->getTime() != t0)
+        return false;
     CC* cc = getCC(t0, c);
+    if (cc == NULL)
+        return false;
     int  v = cc->value;
     bool i = cc->interpolate;
     // Remove it from the list
     removeCC(t0, c);
     // Re-insert it
-    addCC(tF, c, v, i);
+    return addCC(tF, c, v, i);
 }
 
 /**
@@ -258,29 +349,376 @@ void Pattern::setFollow( Pattern *next) {
     follow = next;
 }
 
+/**
+ * Pattern::setLength - Sets how long this pattern plays for before it loops
+ *                      or moves on. Used to lay out arrangements. Returns
+ *                      false if ticks is past max_tick.
+ * @ticks - the length in ticks
+ */
+bool Pattern::setLength( song_tick_t ticks) {
+    if (!tick_in_range(ticks))
+        return false;
+    length = ticks;
+    return true;
+}
+
+/**
+ * Pattern::getLength - gets the length of this pattern in ticks
+ */
+tick_t Pattern::getLength() {
+    return length;
+}
+
 /**
  * Pattern::reset - resets the pattern to the beginning
  */
 void Pattern::reset() {
     currentNote = notes;
     currentCC = ccs;
+    romNote = 0;
+    romCC = 0;
 }
 
 /**
  * Pattern::clear - reinitializes the events in this pattern
  */
 void Pattern::clear() {
+    freeEvents();
+    log.record(change_clear, 0, 0, 0, 0);
+}
+
+/**
+ * Pattern::freeEvents - frees every event and its notes or CCs without
+ *                       recording a change
+ */
+void Pattern::freeEvents() {
     NoteEvent *n = notes;
     while (n != 0) {
         NoteEvent *next = n->getNext();
+        Note *note = n->getNotes();
+        while (note != 0) {
+            Note *list = note->list;
+            free(note);
+            note = list;
+        }
         delete n;
         n = next;
     }
     CCEvent *cc = ccs;
     while (cc != 0) {
         CCEvent *next = cc->getNext();
+        CC *c = cc->getCCs();
+        while (c != 0) {
+            CC *list = c->list;
+            free(c);
+            c = list;
+        }
         delete cc;
         cc = next;
     }
+    notes = (NoteEvent*)0;
+    ccs = (CCEvent*)0;
+    rom = (const PatternLiteral*)0;
     reset();
-}
\ No newline at end of file
+}
+
+/**
+ * Pattern::load - Play a pattern literal straight from flash. Replaces the
+ *                 contents of this pattern without recording a change, so
+ *                 linked devices should load the same literal.
+ * @literal - the pattern literal, declared with PATTERN_LITERAL
+ */
+void Pattern::load( const PatternLiteral* literal) {
+    freeEvents();
+    rom = literal;
+}
+
+/**
+ * Pattern::isReadOnly - true while this pattern still plays from a literal.
+ *                       Use readNote and readCC instead of nextNote and nextCC
+ *                       while this is true to keep it out of RAM.
+ */
+bool Pattern::isReadOnly() {
+    return rom != 0;
+}
+
+/**
+ * Pattern::readNote - copies the next note of a literal out of flash and
+ *                     advances. Returns false at the end of the literal.
+ * @n - where to store the note
+ */
+bool Pattern::readNote( NoteLiteral* n) {
+    if (rom == 0)
+        return false;
+    PatternLiteral lit;
+    memcpy_P(&lit, rom, sizeof(PatternLiteral));
+    if (romNote >= lit.numNotes)
+        return false;
+    memcpy_P(n, &lit.notes[romNote++], sizeof(NoteLiteral));
+    return true;
+}
+
+/**
+ * Pattern::readCC - copies the next CC of a literal out of flash and
+ *                   advances. Returns false at the end of the literal.
+ * @c - where to store the CC
+ */
+bool Pattern::readCC( CCLiteral* c) {
+    if (rom == 0)
+        return false;
+    PatternLiteral lit;
+    memcpy_P(&lit, rom, sizeof(PatternLiteral));
+    if (romCC >= lit.numCCs)
+        return false;
+    memcpy_P(c, &lit.ccs[romCC++], sizeof(CCLiteral));
+    return true;
+}
+
+/**
+ * Pattern::gotoLiteral - moves the readNote and readCC positions to the first
+ *                        note and CC at or after t
+ * @t - tick count
+ */
+void Pattern::gotoLiteral( song_tick_t t) {
+    if (rom == 0)
+        return;
+    if (!tick_in_range(t)) {
+        PatternLiteral lit;
+        memcpy_P(&lit, rom, sizeof(PatternLiteral));
+        romNote = lit.numNotes;
+        romCC = lit.numCCs;
+        return;
+    }
+    romNote = findLiteralNote(t);
+    romCC = findLiteralCC(t);
+}
+
+/**
+ * Pattern::findLiteralNote - binary searches the literal for the first note
+ *                            at or after t. Returns numNotes if there is none.
+ * @t - tick count
+ */
+int Pattern::findLiteralNote( tick_t t) {
+    PatternLiteral lit;
+    memcpy_P(&lit, rom, sizeof(PatternLiteral));
+
+    int lo = 0, hi = lit.numNotes;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        NoteLiteral n;
+        memcpy_P(&n, &lit.notes[mid], sizeof(NoteLiteral));
+        if (n.ticks < t)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * Pattern::findLiteralCC - binary searches the literal for the first CC at or
+ *                          after t. Returns numCCs if there is none.
+ * @t - tick count
+ */
+int Pattern::findLiteralCC( tick_t t) {
+    PatternLiteral lit;
+    memcpy_P(&lit, rom, sizeof(PatternLiteral));
+
+    int lo = 0, hi = lit.numCCs;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        CCLiteral c;
+        memcpy_P(&c, &lit.ccs[mid], sizeof(CCLiteral));
+        if (c.ticks < t)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * Pattern::promote - copies a literal into regular lists so it can be edited.
+ *                    Literals are walked backwards so every insert lands at
+ *                    the head of the list. Not recorded as a change.
+ */
+void Pattern::promote() {
+    if (rom == 0)
+        return;
+    PatternLiteral lit;
+    memcpy_P(&lit, rom, sizeof(PatternLiteral));
+    rom = (const PatternLiteral*)0;
+
+    for (int i = lit.numNotes - 1; i >= 0; i--) {
+        NoteLiteral n;
+        memcpy_P(&n, &lit.notes[i], sizeof(NoteLiteral));
+        if (notes == 0)
+            notes = new NoteEvent(n.ticks, n.note, n.length, n.velocity);
+        else
+            notes = notes->add(n.ticks, n.note, n.length, n.velocity);
+    }
+    for (int i = lit.numCCs - 1; i >= 0; i--) {
+        CCLiteral c;
+        memcpy_P(&c, &lit.ccs[i], sizeof(CCLiteral));
+        if (ccs == 0)
+            ccs = new CCEvent(c.ticks, c.number, c.value, c.interpolate);
+        else
+            ccs = ccs->add(c.ticks, c.number, c.value, c.interpolate);
+    }
+    reset();
+}
+
+/**
+ * Pattern::enableSync - Start recording edits so they can be sent to linked
+ *                       devices as deltas. Call this on every device before
+ *                       the pattern is first edited, so all copies start from
+ *                       the same empty history. Returns false if there is no
+ *                       memory for the change log.
+ */
+bool Pattern::enableSync() {
+    return log.enable();
+}
+
+/**
+ * Pattern::getVersion - gets the number of edits made to this pattern since
+ *                       enableSync. Linked devices remember this to ask for a
+ *                       delta later.
+ */
+unsigned int Pattern::getVersion() {
+    return log.getVersion();
+}
+
+/**
+ * Pattern::writeDelta - Encode the edits made since a version into buf.
+ *                       Returns the number of bytes written, or -1 if sync is
+ *                       not enabled, the change log no longer reaches back
+ *                       that far (resend the whole pattern) or buf is too
+ *                       small.
+ * @since - the version the linked device already has
+ * @buf   - destination buffer
+ * @size  - size of buf in bytes
+ */
+int Pattern::writeDelta( unsigned int since, byte* buf, int size) {
+    return log.encode(since, buf, size);
+}
+
+/**
+ * Pattern::applyDelta - Apply a delta made by writeDelta on a linked device.
+ *                       The delta must start at exactly this pattern's version
+ *                       and history; if this copy was edited locally the
+ *                       histories have diverged and the whole pattern must be
+ *                       resent. The delta is checked completely before
+ *                       anything is applied. Returns the number of bytes read,
+ *                       or -1 if sync is not enabled, the delta is malformed
+ *                       or it doesn't start from this pattern's state.
+ * @buf  - the delta
+ * @size - bytes available in buf
+ */
+int Pattern::applyDelta( const byte* buf, int size) {
+    unsigned long base;
+    if (!log.isEnabled())
+        return -1;
+    int len = ChangeLog::readInt(buf, size, &base);
+    if (len < 0 || len + 3 > size)
+        return -1;
+    uint16_t sum = buf[len] | (buf[len + 1] << 8);
+    byte n = buf[len + 2];
+    len += 3;
+
+    if ((unsigned int)base != getVersion() || sum != log.getChecksum())
+        return -1;
+
+    // Check every record before touching the pattern
+    int start = len;
+    tick_t prev = 0;
+    for (byte i = 0; i < n; i++) {
+        Change c;
+        int r = ChangeLog::readChange(buf + len, size - len, &prev, &c);
+        if (r < 0)
+            return -1;
+        len += r;
+    }
+
+    len = start;
+    prev = 0;
+    for (byte i = 0; i < n; i++) {
+        Change c;
+        len += ChangeLog::readChange(buf + len, size - len, &prev, &c);
+
+        switch (c.op) {
+            case change_note_add:
+                addNote(c.ticks, c.number, c.value, c.extra);
+                break;
+            case change_note_remove:
+                removeNote(c.ticks, c.number);
+                break;
+            case change_cc_add:
+                addCC(c.ticks, c.number, c.value, c.extra != 0);
+                break;
+            case change_cc_remove:
+                removeCC(c.ticks, c.number);
+                break;
+            case change_clear:
+                clear();
+                break;
+        }
+    }
+    return len;
+}
+
+#ifndef ARDUINO
+/**
+ * Pattern::writeDelta - Write a length-prefixed delta to a stream, such as a
+ *                       pipe to a test harness. Returns the number of delta
+ *                       bytes written, or -1 on failure.
+ * @since - the version the reader already has
+ * @out   - the stream
+ */
+int Pattern::writeDelta( unsigned int since, FILE* out) {
+    byte buf[max_delta_size];
+    byte prefix[5];
+
+    int len = writeDelta(since, buf, max_delta_size);
+    if (len < 0)
+        return -1;
+
+    int p = ChangeLog::writeInt(len, prefix, sizeof(prefix));
+    if (fwrite(prefix, 1, p, out) != (size_t)p ||
+        fwrite(buf, 1, len, out) != (size_t)len)
+        return -1;
+    fflush(out);
+    return len;
+}
+
+/**
+ * Pattern::readDelta - Read one length-prefixed delta from a stream and apply
+ *                      it. Returns the result of applyDelta, or -1 at the end
+ *                      of the stream.
+ * @in - the stream
+ */
+int Pattern::readDelta( FILE* in) {
+    byte buf[max_delta_size];
+    unsigned long len = 0;
+    byte shift = 0;
+    int b;
+
+    do {
+        b = fgetc(in);
+        if (b == EOF || shift > 28)
+            return -1;
+        len |= (unsigned long)(b & 0x7f) << shift;
+        shift += 7;
+    } while (b & 0x80);
+
+    // Too big to be ours. Skip it so the next delta stays aligned.
+    if (len > max_delta_size) {
+        while (len-- > 0)
+            if (fgetc(in) == EOF)
+                break;
+        return -1;
+    }
+    if (fread(buf, 1, len, in) != len)
+        return -1;
+    return applyDelta(buf, (int)len);
+}
+#endif
\ No newline at end of file
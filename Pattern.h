@@ -2,12 +2,27 @@
 #define Pattern_h
 #include "NoteEvent.h"
 #include "CCEvent.h"
+#include "ChangeLog.h"
+#include "PatternLiteral.h"
 
 #include "Arduino.h"
+#ifndef ARDUINO
+#include <stdio.h>
+#endif
 
 // Patterns hold event data. Events are implemented as a sequential 
 // linked-list. Your MIDI code should iterate through the event list in here to
 // get note and CC data.
+// After enableSync, every edit is recorded in a ChangeLog so linked devices
+// can be kept in sync by exchanging deltas (see writeDelta and applyDelta)
+// instead of whole patterns.
+// A pattern may also be loaded from a PatternLiteral kept in flash. It then
+// plays read-only through readNote and readCC without copying anything into
+// RAM, and is promoted to regular lists the first time it is edited or walked
+// with the event list calls (nextNote, gotoNote, getNote and the CC
+// equivalents), so existing players keep working at the cost of the copy.
+// Positions past max_tick (see Ticks.h) are rejected: edits return false and
+// lookups find nothing.
 class Pattern {
   private:
     NoteEvent* notes;
@@ -15,6 +30,16 @@ class Pattern {
     CCEvent*   ccs;
     CCEvent*   currentCC;
     Pattern*   follow;
+    tick_t     length;
+    ChangeLog  log;
+    const PatternLiteral* rom;  // In flash. Set while read-only.
+    int        romNote;
+    int        romCC;
+
+    void freeEvents();
+    void promote();
+    int  findLiteralNote( tick_t);
+    int  findLiteralCC( tick_t);
   public:
     char name;
 
@@ -22,26 +47,44 @@ class Pattern {
     ~Pattern();
 
     NoteEvent* nextNote();
-    NoteEvent* gotoNote(int);
-    NoteEvent* getNote(int);
-    Note*      getNote(int, int);
+    NoteEvent* gotoNote( song_tick_t);
+    NoteEvent* getNote( song_tick_t);
+    Note*      getNote( song_tick_t, int);
     
-    void addNote( int, int, int, int);
-    void removeNote(int, int);
-    void moveNote( int, int, int);
+    bool addNote( song_tick_t, int, song_tick_t, int);
+    void removeNote( song_tick_t, int);
+    bool moveNote( song_tick_t, song_tick_t, int);
+    void mergeNotes( const NoteLiteral*, int);
 
     CCEvent* nextCC();
-    CCEvent* gotoCC(int);
-    CCEvent* getCC(int);
-    CC*      getCC(int, int);
+    CCEvent* gotoCC( song_tick_t);
+    CCEvent* getCC( song_tick_t);
+    CC*      getCC( song_tick_t, int);
 
-    void addCC( int, int, int, bool);
-    void removeCC(int, int);
-    void moveCC( int, int, int);
+    bool addCC( song_tick_t, int, int, bool);
+    void removeCC( song_tick_t, int);
+    bool moveCC( song_tick_t, song_tick_t, int);
 
     void setFollow(Pattern*);
+    bool setLength( song_tick_t);
+    tick_t getLength();
     void reset();
     void clear();
+
+    void load(const PatternLiteral*);
+    bool isReadOnly();
+    bool readNote(NoteLiteral*);
+    bool readCC(CCLiteral*);
+    void gotoLiteral( song_tick_t);
+
+    bool enableSync();
+    unsigned int getVersion();
+    int writeDelta( unsigned int, byte*, int);
+    int applyDelta( const byte*, int);
+#ifndef ARDUINO
+    int writeDelta( unsigned int, FILE*);
+    int readDelta( FILE*);
+#endif
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,107 @@
+#ifndef PatternLiteral_h
+#define PatternLiteral_h
+#include "Ticks.h"
+
+#include "Arduino.h"
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#endif
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#ifndef memcpy_P
+#define memcpy_P memcpy
+#endif
+
+typedef struct NoteLiteral {
+    tick_t ticks;
+    byte   note;
+    tick_t length;
+    byte   velocity;
+} NoteLiteral;
+
+typedef struct CCLiteral {
+    tick_t ticks;
+    byte   number;
+    byte   value;
+    bool   interpolate;
+} CCLiteral;
+
+// PatternLiteral describes a pattern whose events live in flash. Declare the
+// event arrays with NOTE_LITERALS and CC_LITERALS so they are checked at
+// compile time, then hand the PatternLiteral to Pattern::load:
+//
+//   NOTE_LITERALS(beatNotes, {0, 36, 24, 100}, {48, 38, 24, 100});
+//   PATTERN_LITERAL(beat, beatNotes, LITERAL_COUNT(beatNotes), 0, 0);
+//   ...
+//   song->getPattern(0)->load(&beat);
+typedef struct PatternLiteral {
+    const NoteLiteral* notes;
+    int                numNotes;
+    const CCLiteral*   ccs;
+    int                numCCs;
+} PatternLiteral;
+
+#define LITERAL_COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+#if __cplusplus >= 201103L
+
+// Literals must be sorted by ticks, then by note (or CC) number, with no
+// duplicates, and hold MIDI-range data. These are evaluated by the compiler.
+// Ranges are checked by halves so long patterns don't hit the constexpr
+// recursion limit.
+constexpr bool noteLiteralValid( const NoteLiteral* n, int i) {
+    return n[i].note < 128 && n[i].velocity < 128 &&
+           (i == 0 || n[i - 1].ticks < n[i].ticks ||
+            (n[i - 1].ticks == n[i].ticks && n[i - 1].note < n[i].note));
+}
+
+constexpr bool noteLiteralsValid( const NoteLiteral* n, int lo, int hi) {
+    return hi - lo <= 1
+        ? (hi == lo || noteLiteralValid(n, lo))
+        : noteLiteralsValid(n, lo, (lo + hi) / 2) &&
+          noteLiteralsValid(n, (lo + hi) / 2, hi);
+}
+
+constexpr bool ccLiteralValid( const CCLiteral* c, int i) {
+    return c[i].number < 128 && c[i].value < 128 &&
+           (i == 0 || c[i - 1].ticks < c[i].ticks ||
+            (c[i - 1].ticks == c[i].ticks && c[i - 1].number < c[i].number));
+}
+
+constexpr bool ccLiteralsValid( const CCLiteral* c, int lo, int hi) {
+    return hi - lo <= 1
+        ? (hi == lo || ccLiteralValid(c, lo))
+        : ccLiteralsValid(c, lo, (lo + hi) / 2) &&
+          ccLiteralsValid(c, (lo + hi) / 2, hi);
+}
+
+#define NOTE_LITERALS(name, ...) \
+    constexpr NoteLiteral name[] PROGMEM = { __VA_ARGS__ }; \
+    static_assert(noteLiteralsValid(name, 0, LITERAL_COUNT(name)), \
+        #name ": notes must be sorted by ticks then note with MIDI-range data")
+
+#define CC_LITERALS(name, ...) \
+    constexpr CCLiteral name[] PROGMEM = { __VA_ARGS__ }; \
+    static_assert(ccLiteralsValid(name, 0, LITERAL_COUNT(name)), \
+        #name ": CCs must be sorted by ticks then number with MIDI-range data")
+
+#define PATTERN_LITERAL(name, notes, numNotes, ccs, numCCs) \
+    constexpr PatternLiteral name PROGMEM = { notes, numNotes, ccs, numCCs }
+
+#else
+
+// Older compilers can't check literals, so they are stored as-is
+#define NOTE_LITERALS(name, ...) \
+    const NoteLiteral name[] PROGMEM = { __VA_ARGS__ }
+
+#define CC_LITERALS(name, ...) \
+    const CCLiteral name[] PROGMEM = { __VA_ARGS__ }
+
+#define PATTERN_LITERAL(name, notes, numNotes, ccs, numCCs) \
+    const PatternLiteral name PROGMEM = { notes, numNotes, ccs, numCCs }
+
+#endif
+
+#endif
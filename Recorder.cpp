@@ -0,0 +1,216 @@
+#include "Arduino.h"
+
+#include "Recorder.h"
+
+// Keeps the compiler (and on hosts, the CPU) from moving input slot accesses
+// past the index updates that hand slots between noteOn/noteOff and capture
+#if defined(__AVR__)
+#define record_barrier() asm volatile("" ::: "memory")
+#else
+#define record_barrier() __sync_synchronize()
+#endif
+
+/**
+ * Recorder::Recorder - Initialize an empty recorder with quantization off
+ */
+Recorder::Recorder() {
+    inputHead = 0;
+    inputTail = 0;
+    numPending = 0;
+    takeSize = 0;
+    grid = 0;
+    loopLength = 0;
+    overruns = 0;
+    dropped = 0;
+}
+
+/**
+ * Recorder::noteOn - Queue a note on. Constant time, safe to call from the
+ *                    MIDI receive path.
+ * @ticks    - the pattern position the note arrived at
+ * @note     - the note number (MIDI number)
+ * @velocity - the velocity of the note. 0 is treated as a note off.
+ */
+void Recorder::noteOn( song_tick_t ticks, byte note, byte velocity) {
+    push(ticks, note, velocity);
+}
+
+/**
+ * Recorder::noteOff - Queue a note off. Constant time, safe to call from the
+ *                     MIDI receive path.
+ * @ticks - the pattern position the note off arrived at
+ * @note  - the note number (MIDI number)
+ */
+void Recorder::noteOff( song_tick_t ticks, byte note) {
+    push(ticks, note, 0);
+}
+
+/**
+ * Recorder::push - Add a message to the input buffer, or count it as dropped
+ *                  if the buffer is full or ticks is past max_tick
+ */
+void Recorder::push( song_tick_t ticks, byte note, byte velocity) {
+    byte head = inputHead;
+    byte next = (head + 1) & (record_buffer_size - 1);
+    if (next == inputTail || !tick_in_range(ticks)) {
+        overruns++;
+        return;
+    }
+
+    input[head].ticks    = ticks;
+    input[head].note     = note;
+    input[head].velocity = velocity;
+
+    record_barrier();
+    inputHead = next;
+}
+
+/**
+ * Recorder::setQuantize - Snap recorded note starts to a grid
+ * @ticks - the grid size in ticks, or 0 to record unquantized
+ */
+void Recorder::setQuantize( tick_t ticks) {
+    grid = ticks;
+}
+
+/**
+ * Recorder::setLoopLength - Set the length of the pattern being recorded.
+ *                           Needed to measure notes held across the loop
+ *                           point and to wrap notes quantized onto its end.
+ * @ticks - the loop length in ticks, or 0 if the pattern doesn't loop
+ */
+void Recorder::setLoopLength( tick_t ticks) {
+    loopLength = ticks;
+}
+
+/**
+ * Recorder::capture - Pair buffered note ons with their note offs. Call this
+ *                     from the main loop often enough that the input buffer
+ *                     doesn't fill up.
+ */
+void Recorder::capture() {
+    byte tail = inputTail;
+
+    while (tail != inputHead) {
+        record_barrier();
+        RecordInput in = input[tail];
+        tail = (tail + 1) & (record_buffer_size - 1);
+
+        // Finish reading the slot before handing it back to the producer
+        record_barrier();
+        inputTail = tail;
+
+        // A repeated note on closes the previous one, so a lost note off
+        // can't leave a voice stuck
+        for (byte i = 0; i < numPending; i++) {
+            if (pending[i].note == in.note) {
+                finish(i, in.ticks);
+                break;
+            }
+        }
+
+        if (in.velocity == 0)
+            continue;
+
+        if (numPending == record_voices) {
+            dropped++;
+            continue;
+        }
+        pending[numPending].start    = in.ticks;
+        pending[numPending].note     = in.note;
+        pending[numPending].velocity = in.velocity;
+        numPending++;
+    }
+}
+
+/**
+ * Recorder::finish - Move a held note into the take now that its length is
+ *                    known. A note released before it started, with no loop
+ *                    length to explain the wrap, is dropped.
+ * @i     - index of the note in the pending list
+ * @ticks - when the note was released
+ */
+void Recorder::finish( byte i, tick_t ticks) {
+    PendingNote* p = &pending[i];
+
+    if (takeSize == record_take_size ||
+        (loopLength == 0 && ticks < p->start)) {
+        dropped++;
+    }
+    else {
+        NoteLiteral* n = &take[takeSize++];
+        tick_t length = ticks - p->start;
+        // Released after the loop point wrapped around
+        if (loopLength != 0 && ticks < p->start)
+            length += loopLength;
+
+        n->ticks    = snap(p->start);
+        n->note     = p->note;
+        n->length   = length;
+        n->velocity = p->velocity;
+    }
+
+    // Fill the gap with the last held note
+    *p = pending[--numPending];
+}
+
+/**
+ * Recorder::snap - Quantize a note start to the nearest grid line
+ * @ticks - the unquantized position
+ */
+tick_t Recorder::snap( tick_t ticks) {
+    if (grid == 0)
+        return ticks;
+
+    tick_t offset = ticks % grid;
+    ticks -= offset;
+    // Round up, unless the next grid line is past the end of the tick range
+    // and ticks would wrap to 0
+    if (offset >= grid - grid / 2 && ticks <= (tick_t)-1 - grid)
+        ticks += grid;
+    if (loopLength != 0 && ticks >= loopLength)
+        ticks -= loopLength;
+    return ticks;
+}
+
+/**
+ * Recorder::merge - Overdub the finished notes onto a pattern. Call this at
+ *                   the loop boundary. Returns the number of notes merged.
+ * @p - the pattern being recorded
+ */
+int Recorder::merge( Pattern* p) {
+    capture();
+
+    // Insertion sort by start time. Takes are short and mostly in order.
+    for (byte i = 1; i < takeSize; i++) {
+        NoteLiteral n = take[i];
+        byte j = i;
+        while (j > 0 && n.ticks < take[j - 1].ticks) {
+            take[j] = take[j - 1];
+            j--;
+        }
+        take[j] = n;
+    }
+
+    int merged = takeSize;
+    p->mergeNotes(take, takeSize);
+    takeSize = 0;
+    return merged;
+}
+
+/**
+ * Recorder::clear - Throw away buffered input, held notes and the take
+ */
+void Recorder::clear() {
+    inputTail = inputHead;
+    numPending = 0;
+    takeSize = 0;
+}
+
+/**
+ * Recorder::getDropped - gets the number of messages or notes lost because
+ *                        a buffer was full or their position was out of range
+ */
+unsigned int Recorder::getDropped() {
+    return overruns + dropped;
+}
@@ -0,0 +1,87 @@
+#ifndef Recorder_h
+#define Recorder_h
+#include "Pattern.h"
+#include "PatternLiteral.h"
+#include "Ticks.h"
+
+#include "Arduino.h"
+
+// Number of incoming note on/off messages buffered between captures. Must be
+// a power of two no larger than 256.
+#ifndef record_buffer_size
+#define record_buffer_size 16
+#endif
+#if record_buffer_size > 256 || record_buffer_size < 2 || \
+    (record_buffer_size & (record_buffer_size - 1)) != 0
+#error "record_buffer_size must be a power of two no larger than 256"
+#endif
+
+// Number of notes that may be held down at once while recording
+#ifndef record_voices
+#define record_voices 8
+#endif
+#if record_voices > 255
+#error "record_voices must be at most 255"
+#endif
+
+// Number of finished notes kept until the next merge
+#ifndef record_take_size
+#define record_take_size 16
+#endif
+#if record_take_size > 255
+#error "record_take_size must be at most 255"
+#endif
+
+typedef struct RecordInput {
+    tick_t ticks;
+    byte   note;
+    byte   velocity;  // 0 for note off
+} RecordInput;
+
+typedef struct PendingNote {
+    tick_t start;
+    byte   note;
+    byte   velocity;
+} PendingNote;
+
+// Recorder captures live MIDI input into a pattern. noteOn and noteOff are
+// safe to call from a MIDI callback or interrupt: they only copy the message
+// into a single-producer, single-consumer ring buffer. The main loop calls
+// capture to pair note ons with their note offs, which fills in the note
+// length, and merge at each loop boundary to write the finished notes into a
+// pattern in one pass. Notes still held at the boundary carry over to the
+// next merge.
+class Recorder {
+  private:
+    RecordInput   input[record_buffer_size];
+    volatile byte inputHead;   // Written only by noteOn/noteOff
+    volatile byte inputTail;   // Written only by capture
+    PendingNote   pending[record_voices];
+    byte          numPending;
+    NoteLiteral   take[record_take_size];
+    byte          takeSize;
+    tick_t        grid;
+    tick_t        loopLength;
+    volatile unsigned int overruns;  // Written only by noteOn/noteOff
+    unsigned int  dropped;           // Written only by capture
+
+    void push( song_tick_t, byte, byte);
+    void finish( byte, tick_t);
+    tick_t snap( tick_t);
+  public:
+    Recorder();
+
+    void noteOn( song_tick_t, byte, byte);
+    void noteOff( song_tick_t, byte);
+
+    void setQuantize( tick_t);
+    void setLoopLength( tick_t);
+
+    void capture();
+    int  merge( Pattern*);
+    void clear();
+
+    unsigned int getDropped();
+};
+
+#endif
@@ -17,12 +17,15 @@ Song::Song() {
         patterns[i] = new Pattern();
         patterns[i]->name = 'a' + i;
     }
+
+    arrangement = new Arrangement(patterns, num_patterns);
 }
 
 /**
  * Song::~Song - Frees space for loading a new song
  */
 Song::~Song() {
+    delete arrangement;
     for (int i = 0; i < num_patterns; i++) {
         delete patterns[i];
     }
@@ -35,4 +38,11 @@ Song::~Song() {
  */
 Pattern* Song::getPattern(int p) {
     return patterns[p];
+}
+
+/**
+ * Song::getArrangement - retrieves the song's arrangement of patterns
+ */
+Arrangement* Song::getArrangement() {
+    return arrangement;
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef Song_h
 #define Song_h
 #include "Pattern.h"
+#include "Arrangement.h"
 
 #include "Arduino.h"
 
@@ -11,9 +12,12 @@
 // My goal with this library is to offer the finest granularity of control over
 // musical parameters in a well-organized and useful way. Useful for sequencers
 // and possibly other applications.
+// Patterns can be chained with Pattern::setFollow, or laid out on a timeline
+// with repeats and transposition through the song's Arrangement.
 class Song {
   private:
     Pattern **patterns;
+    Arrangement *arrangement;
   public:
     float tempo;
     float swing;
@@ -21,6 +25,7 @@ class Song {
     Song();
     ~Song();
     Pattern* getPattern(int);
+    Arrangement* getArrangement();
 };
 
 #endif
\ No newline at end of file
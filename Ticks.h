@@ -0,0 +1,38 @@
+#ifndef Ticks_h
+#define Ticks_h
+#include "Arduino.h"
+
+// Width of pattern ticks in bits, 16 or 32. 16-bit ticks reach 65535 ticks
+// (about 68 beats at 960 PPQ) per pattern and keep events small, so they are
+// the default on AVR boards. Everything else defaults to 32-bit. Linked devices
+// exchanging deltas must use the same width.
+#ifndef tick_bits
+#if defined(__AVR__)
+#define tick_bits 16
+#else
+#define tick_bits 32
+#endif
+#endif
+
+#if tick_bits == 16
+typedef uint16_t tick_t;
+typedef int16_t  tick_diff_t;
+#else
+typedef uint32_t tick_t;
+typedef int32_t  tick_diff_t;
+#endif
+
+// Absolute positions in a whole song are always 32-bit
+typedef uint32_t song_tick_t;
+
+// The last tick a pattern can hold. Pattern and Recorder take positions as
+// song_tick_t and reject anything past this instead of letting it wrap, so
+// addNote(70000, ...) fails with 16-bit ticks rather than landing on 4464.
+#define max_tick ((tick_t)-1)
+#if tick_bits == 16
+#define tick_in_range(t) ((song_tick_t)(t) <= max_tick)
+#else
+#define tick_in_range(t) true
+#endif
+
+#endif
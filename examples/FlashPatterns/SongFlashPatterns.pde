@@ -0,0 +1,73 @@
+#include "Song.h"
+
+// Demo patterns kept in flash. These are checked at compile time, so an
+// out-of-order or out-of-range event is a build error.
+NOTE_LITERALS(beatNotes,
+  {0,  36, 24, 100},
+  {0,  42, 12, 80},
+  {24, 42, 12, 60},
+  {48, 38, 24, 100},
+  {72, 42, 12, 60}
+);
+CC_LITERALS(beatCCs,
+  {0,  74, 20, true},
+  {72, 74, 90, false}
+);
+PATTERN_LITERAL(beat, beatNotes, LITERAL_COUNT(beatNotes),
+                beatCCs, LITERAL_COUNT(beatCCs));
+
+Song *song;
+
+void setup() {
+  Serial.begin(9600);
+  pinMode(2, INPUT_PULLUP);
+  pinMode(3, INPUT_PULLUP);
+
+  song = new Song();
+  // Nothing is copied into RAM here
+  song->getPattern(0)->load(&beat);
+}
+
+void loop() {
+  if (!digitalRead(2)) {
+    printPattern(song->getPattern(0));
+    delay(500);
+  }
+  if (!digitalRead(3)) {
+    // The first edit promotes the literal to a regular, editable pattern
+    song->getPattern(0)->addNote(96, 36, 24, 100);
+    delay(500);
+  }
+}
+
+void printPattern(Pattern* p) {
+  if (p->isReadOnly()) {
+    NoteLiteral n;
+    while (p->readNote(&n)) {
+      Serial.print(n.ticks);
+      Serial.print(" ");
+      Serial.print(n.note);
+      Serial.print(" ");
+      Serial.print(n.length);
+      Serial.print(" ");
+      Serial.println(n.velocity);
+    }
+  }
+  else {
+    NoteEvent *ne = p->nextNote();
+    while (ne != (NoteEvent*)0) {
+      for (Note* n = ne->getNotes(); n != (Note*)0; n = n->list) {
+        Serial.print(ne->getTime());
+        Serial.print(" ");
+        Serial.print(n->note);
+        Serial.print(" ");
+        Serial.print(n->length);
+        Serial.print(" ");
+        Serial.println(n->velocity);
+      }
+      ne = p->nextNote();
+    }
+  }
+  Serial.println();
+  p->reset();
+}